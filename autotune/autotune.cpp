@@ -0,0 +1,109 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include <omp.h>
+
+#include "autotune.h"
+
+// подбор параметров для произведения матрицы на вектор из task2.1 / task3.1:
+// число потоков, расписание и порция для цикла по строкам, ширина блока столбцов.
+// ./autotune [M] [N] [retune] - retune заново замеряет и перезаписывает запись в кэше
+
+/*
+ * matrix_vector_product_tuned: c[m] = a[m][n] * b[n]; при block > 0 строки обрабатываются
+ * порциями по 8, а столбцы - полосами ширины block, чтобы полоса b оставалась в кэше
+ */
+void matrix_vector_product_tuned(const double* a, const double* b, double* c, int m, int n, const TuneConfig& cfg)
+{
+    if (cfg.block <= 0) {
+        apply_omp_schedule(cfg);
+        #pragma omp parallel for schedule(runtime) num_threads(cfg.threads)
+        for (int i = 0; i < m; i++) {
+            double sum = 0.0;
+            for (int j = 0; j < n; j++)
+                sum += a[(size_t)i * n + j] * b[j];
+            c[i] = sum;
+        }
+        return;
+    }
+
+    const int rows = 8;
+    TuneConfig tiled = cfg;  // порция в группах строк, а не в строках
+    if (tiled.chunk > 0)
+        tiled.chunk = tiled.chunk / rows > 0 ? tiled.chunk / rows : 1;
+    apply_omp_schedule(tiled);
+    #pragma omp parallel for schedule(runtime) num_threads(cfg.threads)
+    for (int ib = 0; ib < (m + rows - 1) / rows; ib++) {
+        int lb = ib * rows;
+        int ub = lb + rows < m ? lb + rows : m;
+        double sum[rows] = {0};
+        for (int jb = 0; jb < n; jb += cfg.block) {
+            int je = jb + cfg.block < n ? jb + cfg.block : n;
+            for (int i = lb; i < ub; i++)
+                for (int j = jb; j < je; j++)
+                    sum[i - lb] += a[(size_t)i * n + j] * b[j];
+        }
+        for (int i = lb; i < ub; i++)
+            c[i] = sum[i - lb];
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    size_t M = 20000;
+    size_t N = 20000;
+    bool retune = false;
+
+    int positional = 0;  // retune может стоять где угодно и в счет позиций M, N не входит
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "retune") == 0) {
+            retune = true;
+            continue;
+        }
+        char* end = nullptr;
+        long long value = strtoll(argv[i], &end, 10);
+        if (*argv[i] == '\0' || *end != '\0' || value <= 0 || positional >= 2) {
+            fprintf(stderr, "usage: %s [M] [N] [retune]\n", argv[0]);
+            return 1;
+        }
+        if (positional++ == 0)
+            M = value;
+        else
+            N = value;
+    }
+
+    std::vector<double> a(M * N), b(N), c(M);
+    #pragma omp parallel for
+    for (size_t i = 0; i < M; i++)
+        for (size_t j = 0; j < N; j++)
+            a[i * N + j] = i + j;
+    for (size_t j = 0; j < N; j++)
+        b[j] = j;
+
+    AutoTuner tuner("", true);
+    auto kernel = [&](const TuneConfig& cfg) { matrix_vector_product_tuned(a.data(), b.data(), c.data(), M, N, cfg); };
+
+    TuneSpace space;
+    space.iterations = M;
+    space.blocks = {0};
+    for (int block : {512, 2048, 8192})
+        if ((size_t)block < N)  // полоса шире строки ничем не отличается от прохода без блоков
+            space.blocks.push_back(block);
+
+    TuneConfig cfg;
+    if (retune) {
+        cfg = tuner.search(kernel, space);
+        tuner.store("matvec", {M, N}, cfg);
+    } else {
+        cfg = tuner.tune("matvec", {M, N}, kernel, space);
+    }
+    printf("M=%zu N=%zu CPU %s\n", M, N, AutoTuner::cpu_model().c_str());
+    printf("Tuned: %s\n", AutoTuner::describe(cfg).c_str());
+
+    double t = omp_get_wtime();
+    kernel(cfg);
+    t = omp_get_wtime() - t;
+    printf("Elapsed time (tuned): %.6f sec.\n", t);
+    return 0;
+}
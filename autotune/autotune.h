@@ -0,0 +1,281 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <optional>
+#include <functional>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <thread>
+#include <algorithm>
+#include <cstdlib>
+#include <cstdio>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// автоподбор параметров параллельного ядра вместо ручных переборов {1,2,4,7,8,16,20,40}:
+// короткими замерами подбираются число потоков, расписание и порция (chunk), размер блока.
+// победитель сохраняется в файл с ключом "модель CPU + ядро + классы размеров задачи",
+// и следующие запуски на этой машине берут конфигурацию из файла без замеров
+
+enum class TuneSchedule { Static, Dynamic, Guided };
+
+struct TuneConfig {
+    int threads = 1;
+    TuneSchedule schedule = TuneSchedule::Static;
+    int chunk = 0;        // 0 - порция по умолчанию для расписания
+    int block = 0;        // размер блока, смысл задает ядро; 0 - без блоков
+    double seconds = 0;   // медианное время одного прогона при подборе
+};
+
+// пространство поиска; пустой список - значения подбираются автоматически
+struct TuneSpace {
+    std::vector<int> threads;                 // по умолчанию степени двойки до числа ядер и само число ядер
+    std::vector<TuneSchedule> schedules = {TuneSchedule::Static, TuneSchedule::Dynamic, TuneSchedule::Guided};
+    std::vector<int> chunks;                  // по умолчанию 0 и iterations / (threads * {1, 4, 16})
+    std::vector<int> blocks = {0};
+    size_t iterations = 0;                    // число итераций параллельного цикла, для подбора chunk
+    int repeats = 3;                          // минимум прогонов на конфигурацию
+    double minTrialSeconds = 0.05;            // прогоны повторяются, пока суммарно не пройдет столько времени
+    double minGain = 0.03;                    // новая конфигурация должна быть быстрее лучшей хотя бы на 3%
+};
+
+inline const char* schedule_name(TuneSchedule schedule) {
+    switch (schedule) {
+        case TuneSchedule::Dynamic: return "dynamic";
+        case TuneSchedule::Guided: return "guided";
+        default: return "static";
+    }
+}
+
+inline TuneSchedule schedule_from_name(const std::string& name) {
+    if (name == "dynamic")
+        return TuneSchedule::Dynamic;
+    if (name == "guided")
+        return TuneSchedule::Guided;
+    return TuneSchedule::Static;
+}
+
+#ifdef _OPENMP
+// расписание для циклов с schedule(runtime)
+inline void apply_omp_schedule(const TuneConfig& config) {
+    omp_sched_t kind = omp_sched_static;
+    if (config.schedule == TuneSchedule::Dynamic)
+        kind = omp_sched_dynamic;
+    else if (config.schedule == TuneSchedule::Guided)
+        kind = omp_sched_guided;
+    omp_set_schedule(kind, config.chunk);
+}
+#endif
+
+class AutoTuner {
+public:
+    using Kernel = std::function<void(const TuneConfig&)>;  // один прогон ядра с заданными параметрами
+
+private:
+    std::string cachePath;
+    std::map<std::string, TuneConfig> cache;
+    bool verbose;
+
+public:
+    // путь к кэшу: аргумент, иначе переменная окружения AUTOTUNE_CACHE, иначе autotune.cache в текущем каталоге
+    explicit AutoTuner(std::string path = "", bool verbose = false) : verbose(verbose) {
+        if (path.empty()) {
+            const char* env = std::getenv("AUTOTUNE_CACHE");
+            path = env ? env : "autotune.cache";
+        }
+        cachePath = path;
+        load();
+    }
+
+    // модель процессора и число аппаратных потоков - разные машины получают разные записи.
+    // на aarch64 строки "model name" нет: берутся CPU implementer и все различные CPU part
+    // (у big.LITTLE их несколько), при их отсутствии - строка Hardware
+    static std::string cpu_model() {
+        return cpu_model_from(std::ifstream("/proc/cpuinfo")) + "_x" + std::to_string(std::thread::hardware_concurrency());
+    }
+
+    static std::string cpu_model_from(std::istream&& cpuinfo) {
+        std::string line, model, implementer, hardware;
+        std::vector<std::string> parts;
+        while (std::getline(cpuinfo, line)) {
+            size_t colon = line.find(':');
+            if (colon == std::string::npos)
+                continue;
+            std::string value = line.substr(colon + 1);
+            value.erase(0, value.find_first_not_of(" \t"));
+            if (line.rfind("model name", 0) == 0 && model.empty())
+                model = value;
+            else if (line.rfind("CPU implementer", 0) == 0 && implementer.empty())
+                implementer = value;
+            else if (line.rfind("CPU part", 0) == 0 && std::find(parts.begin(), parts.end(), value) == parts.end())
+                parts.push_back(value);
+            else if (line.rfind("Hardware", 0) == 0 && hardware.empty())
+                hardware = value;
+        }
+        if (model.empty() && !implementer.empty()) {
+            model = "impl_" + implementer + "_part";
+            std::sort(parts.begin(), parts.end());
+            for (const std::string& part : parts)
+                model += "_" + part;
+        }
+        if (model.empty())
+            model = hardware.empty() ? "unknown" : hardware;
+        std::replace(model.begin(), model.end(), ' ', '_');
+        std::replace(model.begin(), model.end(), '\t', '_');
+        return model;
+    }
+
+    // класс размера: ближайшая сверху степень двойки, задачи близкого размера делят одну запись
+    static size_t size_class(size_t problemSize) {
+        size_t cls = 1;
+        while (cls < problemSize)
+            cls <<= 1;
+        return cls;
+    }
+
+    // размеры задачи по каждому измерению, например {M, N}: у 1000x1000000 и 1000000x1000
+    // разные лучшие параметры, поэтому класс размера считается по каждому измерению отдельно
+    static std::string size_key(const std::vector<size_t>& dims) {
+        std::string result;
+        for (size_t dim : dims)
+            result += (result.empty() ? "" : "x") + std::to_string(size_class(dim));
+        return result;
+    }
+
+    std::optional<TuneConfig> lookup(const std::string& kernel, const std::vector<size_t>& dims) const {
+        auto it = cache.find(key(kernel, dims));
+        if (it == cache.end())
+            return std::nullopt;
+        return it->second;
+    }
+
+    void store(const std::string& kernel, const std::vector<size_t>& dims, const TuneConfig& config) {
+        cache[key(kernel, dims)] = config;
+        save();
+    }
+
+    // конфигурация из кэша, а при ее отсутствии - подбор и запись в кэш; имя ядра без пробелов
+    TuneConfig tune(const std::string& kernel, const std::vector<size_t>& dims, const Kernel& run, const TuneSpace& space = {}) {
+        if (auto cached = lookup(kernel, dims)) {
+            if (verbose)
+                std::printf("autotune: %s size %s from cache: %s\n", kernel.c_str(), size_key(dims).c_str(),
+                            describe(*cached).c_str());
+            return *cached;
+        }
+        TuneConfig best = search(run, space);
+        store(kernel, dims, best);
+        return best;
+    }
+
+    // подбор по координатам: сначала число потоков, затем расписание с порцией, затем блок
+    TuneConfig search(const Kernel& run, const TuneSpace& space) {
+        TuneConfig best;
+        best.seconds = -1;
+
+        std::vector<int> threads = space.threads;
+        if (threads.empty()) {
+            int hw = std::max(1u, std::thread::hardware_concurrency());
+            for (int t = 1; t < hw; t *= 2)
+                threads.push_back(t);
+            threads.push_back(hw);
+        }
+        for (int t : threads) {
+            TuneConfig config = best;
+            config.threads = t;
+            try_config(run, config, space, best);
+        }
+
+        for (TuneSchedule schedule : space.schedules) {
+            std::vector<int> chunks = space.chunks;
+            if (chunks.empty()) {
+                chunks.push_back(0);
+                for (int div : {1, 4, 16}) {
+                    int chunk = static_cast<int>(space.iterations / (static_cast<size_t>(best.threads) * div));
+                    if (chunk > 0 && std::find(chunks.begin(), chunks.end(), chunk) == chunks.end())
+                        chunks.push_back(chunk);
+                }
+            }
+            for (int chunk : chunks) {
+                TuneConfig config = best;
+                config.schedule = schedule;
+                config.chunk = chunk;
+                try_config(run, config, space, best);
+            }
+        }
+
+        for (int block : space.blocks) {
+            TuneConfig config = best;
+            config.block = block;
+            try_config(run, config, space, best);
+        }
+        return best;
+    }
+
+    static std::string describe(const TuneConfig& config) {
+        std::ostringstream out;
+        out << "threads " << config.threads << ", schedule " << schedule_name(config.schedule)
+            << ", chunk " << config.chunk << ", block " << config.block << ", " << config.seconds << " s";
+        return out.str();
+    }
+
+private:
+    std::string key(const std::string& kernel, const std::vector<size_t>& dims) const {
+        return cpu_model() + " " + kernel + " " + size_key(dims);
+    }
+
+    // прогрев, затем прогоны, пока их не станет space.repeats и не пройдет space.minTrialSeconds;
+    // время конфигурации - медиана прогона. лучшая заменяется, только если выигрыш больше шума (minGain)
+    void try_config(const Kernel& run, TuneConfig config, const TuneSpace& space, TuneConfig& best) {
+        if (best.seconds >= 0 && config.threads == best.threads && config.schedule == best.schedule
+            && config.chunk == best.chunk && config.block == best.block)
+            return;  // уже замерено
+        run(config);
+        std::vector<double> times;
+        double total = 0;
+        while (static_cast<int>(times.size()) < std::max(1, space.repeats) || total < space.minTrialSeconds) {
+            auto start = std::chrono::steady_clock::now();
+            run(config);
+            double t = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            times.push_back(t);
+            total += t;
+        }
+        std::nth_element(times.begin(), times.begin() + times.size() / 2, times.end());
+        config.seconds = times[times.size() / 2];
+        if (verbose)
+            std::printf("autotune: %s (%zu runs)\n", describe(config).c_str(), times.size());
+        if (best.seconds < 0 || config.seconds < best.seconds * (1 - space.minGain))
+            best = config;
+    }
+
+    // формат строки: cpu kernel size_key threads schedule chunk block seconds
+    void load() {
+        std::ifstream in(cachePath);
+        std::string line;
+        while (std::getline(in, line)) {
+            std::istringstream fields(line);
+            std::string cpu, kernel, cls, schedule;
+            TuneConfig config;
+            if (fields >> cpu >> kernel >> cls >> config.threads >> schedule >> config.chunk >> config.block >> config.seconds) {
+                config.schedule = schedule_from_name(schedule);
+                cache[cpu + " " + kernel + " " + cls] = config;
+            }
+        }
+    }
+
+    // запись во временный файл и переименование, чтобы прерванный запуск не испортил кэш
+    void save() const {
+        std::string tmp = cachePath + ".tmp";
+        {
+            std::ofstream out(tmp);
+            for (const auto& [k, config] : cache)
+                out << k << " " << config.threads << " " << schedule_name(config.schedule) << " "
+                    << config.chunk << " " << config.block << " " << config.seconds << "\n";
+        }
+        std::rename(tmp.c_str(), cachePath.c_str());
+    }
+};
@@ -8,10 +8,33 @@
 #include <vector>
 #include <limits.h>
 
+#include "../../../autotune/autotune.h"
+
 double loss_prev = INT_MAX;
 
+// один проход метода: x_new = x - tet * (A * x - b), возвращает квадрат нормы невязки
+double iterationStep(const std::vector<double> &A, const std::vector<double> &b, const std::vector<double> &x,
+                     std::vector<double> &x_new, std::vector<double> &err_chisl, double tet, int n, const TuneConfig &cfg)
+{
+    double chisl = 0;
+    apply_omp_schedule(cfg);
+
+    #pragma omp parallel for schedule(runtime) num_threads(cfg.threads)  // расписание и порция из cfg
+    for (int i = 0; i < n; i++) {
+        double sum = 0;
+        for (int j = 0; j < n; j++)
+            sum += A[i * n + j] * x[j];
+        x_new[i] = sum - b[i];
+        err_chisl[i] = pow(x_new[i], 2);
+        x_new[i] = x[i] - tet * x_new[i];
+        #pragma omp atomic
+        chisl += err_chisl[i];
+    }
+    return chisl;
+}
+
 std::vector<double> simpleIterationMethod(const std::vector<double> &A, const std::vector<double> &b,
-                                          double eps, int nm, int n, double b_znam)
+                                          double eps, const TuneConfig &cfg, int n, double b_znam)
 {
     std::vector<double> x(n, 0.0);
     double tet = 0.0001;
@@ -19,19 +42,7 @@ std::vector<double> simpleIterationMethod(const std::vector<double> &A, const st
     while (err > eps) {
         std::vector<double> x_new(n, 0.0);
         std::vector<double> err_chisl(n, 0.0);
-        double chisl = 0;
-
-        #pragma omp parallel for schedule(dynamic, n/nm) num_threads(nm)  // оставляем часть не занятыми, чтобы по готовности поток брал
-        for (int i = 0; i < n; i++) {
-            double sum = 0;
-            for (int j = 0; j < n; j++)
-                sum += A[i * n + j] * x[j];
-            x_new[i] = sum - b[i];
-            err_chisl[i] = pow(x_new[i], 2);
-            x_new[i] = x[i] - tet * x_new[i];
-            #pragma omp atomic
-            chisl += err_chisl[i];
-        }
+        double chisl = iterationStep(A, b, x, x_new, err_chisl, tet, n, cfg);
 
         err = sqrt(chisl) / sqrt(b_znam);
         if ((loss_prev - err) < 0.0001)
@@ -43,22 +54,41 @@ std::vector<double> simpleIterationMethod(const std::vector<double> &A, const st
 }
 
 int main(int argc, char* argv[]) {
-    int num_threads = 1;
+    int num_threads = 0;  // 0 - параметры берутся из autotune.cache, при отсутствии подбираются
     if (argc > 1)
         num_threads = atoi(argv[1]);
     int n = 13700;
 
     // Создание и заполнение одномерного массива для матрицы A
     std::vector<double> A(n * n, 1.0);
-    #pragma omp parallel for num_threads(num_threads)
+    #pragma omp parallel for num_threads(num_threads > 0 ? num_threads : omp_get_max_threads())
     for (int i = 0; i < n; i++)
         A[i * n + i] = 2.0;
 
     std::vector<double> b(n, 1 + n);
     double b_znam = pow(n + 1, 2) * n;
     double tolerance = 0.00001;
+
+    TuneConfig cfg;
+    if (num_threads > 0) {
+        // оставляем часть не занятыми, чтобы по готовности поток брал
+        cfg.threads = num_threads;
+        cfg.schedule = TuneSchedule::Dynamic;
+        cfg.chunk = n / num_threads;
+    } else {
+        std::vector<double> x(n, 0.0), x_new(n), err_chisl(n);
+        TuneSpace space;
+        space.iterations = n;
+        space.repeats = 2;
+        AutoTuner tuner;
+        cfg = tuner.tune("simple_iteration", {static_cast<size_t>(n)}, [&](const TuneConfig &trial) {
+            iterationStep(A, b, x, x_new, err_chisl, 0.0001, n, trial);
+        }, space);
+        std::cout << "autotune: " << AutoTuner::describe(cfg) << std::endl;
+    }
+
     double t1 = omp_get_wtime();
-    std::vector<double> solution = simpleIterationMethod(A, b, tolerance, num_threads, n, b_znam);
+    std::vector<double> solution = simpleIterationMethod(A, b, tolerance, cfg, n, b_znam);
     t1 = omp_get_wtime() - t1;
     // for (int i = 0; i < std::min(10, n); ++i)
     //     std::cout << "x[" << i << "] = " << solution[i] << std::endl;
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cmath>
+#include <vector>
+
+// гистограмма задержек в стиле HDR: 64 линейных поддиапазона на каждую степень двойки,
+// относительная погрешность значения не больше 1/64 (~1.6%).
+// record() - один relaxed fetch_add, поэтому писать можно из нескольких потоков сразу
+class LatencyHistogram {
+private:
+    static constexpr int SUB_BITS = 7;                     // 128 ячеек в первом, линейном диапазоне
+    static constexpr uint64_t SUB_COUNT = 1ull << SUB_BITS;
+    static constexpr uint64_t HALF_COUNT = SUB_COUNT / 2;
+    static constexpr size_t NUM_BUCKETS = (64 - SUB_BITS + 1) * HALF_COUNT + HALF_COUNT;
+
+    std::vector<std::atomic<uint64_t>> buckets;
+    std::atomic<uint64_t> total{0};
+    std::atomic<uint64_t> sum{0};
+    std::atomic<uint64_t> maxValue{0};
+
+    static size_t index_of(uint64_t value) {
+        if (value < SUB_COUNT)
+            return value;
+        int high = 63 - __builtin_clzll(value);  // номер старшего бита
+        int shift = high - SUB_BITS + 1;
+        return shift * HALF_COUNT + (value >> shift);
+    }
+
+    // нижняя граница значений ячейки и ее ширина
+    static uint64_t lower_bound(size_t index) {
+        if (index < SUB_COUNT)
+            return index;
+        uint64_t shift = index / HALF_COUNT - 1;
+        return (index - shift * HALF_COUNT) << shift;
+    }
+
+    static uint64_t width(size_t index) {
+        if (index < SUB_COUNT)
+            return 1;
+        return 1ull << (index / HALF_COUNT - 1);
+    }
+
+public:
+    LatencyHistogram() : buckets(NUM_BUCKETS) {}
+
+    void record(uint64_t value) {
+        buckets[index_of(value)].fetch_add(1, std::memory_order_relaxed);
+        total.fetch_add(1, std::memory_order_relaxed);
+        sum.fetch_add(value, std::memory_order_relaxed);
+        uint64_t prev = maxValue.load(std::memory_order_relaxed);
+        while (prev < value && !maxValue.compare_exchange_weak(prev, value, std::memory_order_relaxed)) {}
+    }
+
+    uint64_t count() const { return total.load(); }
+    uint64_t max() const { return maxValue.load(); }
+
+    double mean() const {
+        uint64_t n = count();
+        return n ? static_cast<double>(sum.load()) / n : 0.0;
+    }
+
+    // значение, не превышаемое p процентами измерений (середина найденной ячейки)
+    uint64_t percentile(double p) const {
+        uint64_t n = count();
+        if (n == 0)
+            return 0;
+        uint64_t target = static_cast<uint64_t>(std::ceil(p / 100.0 * n));
+        if (target == 0)
+            target = 1;
+        uint64_t seen = 0;
+        for (size_t i = 0; i < NUM_BUCKETS; ++i) {
+            seen += buckets[i].load(std::memory_order_relaxed);
+            if (seen >= target) {
+                uint64_t value = lower_bound(i) + width(i) / 2;
+                return value < max() ? value : max();
+            }
+        }
+        return max();
+    }
+};
@@ -0,0 +1,368 @@
+#pragma once
+
+#include <thread>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include "histogram.h"
+
+// конвейер обработки кадров по мотивам task5: чтение -> N обработчиков -> восстановление порядка -> запись.
+// кадры берутся из заранее выделенного пула и передаются между стадиями по указателю,
+// поэтому в памяти одновременно не больше poolSize кадров, а кадр уходит в запись,
+// как только готовы все кадры с меньшими номерами
+
+using PipelineClock = std::chrono::steady_clock;
+
+// кадр из пула; буфер выделяется один раз и переиспользуется
+struct Frame {
+    long index = -1;                     // номер кадра в потоке
+    int width = 0;
+    int height = 0;
+    std::vector<uint8_t> data;           // пиксели, width * height * channels байт
+    PipelineClock::time_point readTime;  // момент чтения, для задержки кадра
+    PipelineClock::time_point stageTime; // момент поступления кадра на текущую стадию
+};
+
+// пул кадров: acquire ждет, пока какой-нибудь кадр не вернут через release
+class FramePool {
+private:
+    std::vector<Frame> frames;
+    std::vector<Frame*> freeFrames;  // стек свободных кадров
+    std::mutex mtx;
+    std::condition_variable cv;
+
+public:
+    FramePool(size_t count, size_t frameBytes) : frames(count) {
+        freeFrames.reserve(count);
+        for (Frame& frame : frames) {
+            frame.data.resize(frameBytes);
+            freeFrames.push_back(&frame);
+        }
+    }
+
+    size_t size() const { return frames.size(); }
+
+    Frame* acquire() {
+        std::unique_lock<std::mutex> lock(mtx);
+        cv.wait(lock, [&] { return !freeFrames.empty(); });
+        Frame* frame = freeFrames.back();
+        freeFrames.pop_back();
+        return frame;
+    }
+
+    void release(Frame* frame) {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            freeFrames.push_back(frame);
+        }
+        cv.notify_one();
+    }
+};
+
+// ограниченная очередь для нескольких писателей и читателей (MPMC).
+// после close() pop отдает оставшееся и затем возвращает false - таймауты не нужны
+template<typename T>
+class BoundedQueue {
+private:
+    std::vector<T> buffer;
+    size_t head = 0;
+    size_t count = 0;
+    bool closed = false;
+    std::mutex mtx;
+    std::condition_variable notEmpty;
+    std::condition_variable notFull;
+
+public:
+    explicit BoundedQueue(size_t capacity) : buffer(capacity) {}
+
+    void push(T value) {
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            notFull.wait(lock, [&] { return count < buffer.size(); });
+            buffer[(head + count) % buffer.size()] = std::move(value);
+            ++count;
+        }
+        notEmpty.notify_one();
+    }
+
+    bool pop(T& value) {
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            notEmpty.wait(lock, [&] { return count != 0 || closed; });
+            if (count == 0)
+                return false;
+            value = std::move(buffer[head]);
+            head = (head + 1) % buffer.size();
+            --count;
+        }
+        notFull.notify_one();
+        return true;
+    }
+
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            closed = true;
+        }
+        notEmpty.notify_all();
+    }
+};
+
+// очередь для одного писателя и одного читателя (SPSC): в обычном режиме без блокировок,
+// а если очередь пуста (полна) несколько попыток подряд, читатель (писатель) засыпает
+// на условной переменной и не занимает ядро, пока другая сторона его не разбудит
+template<typename T>
+class SpscQueue {
+private:
+    static constexpr int SPIN_TRIES = 64;  // попыток перед сном
+
+    std::vector<T> buffer;
+    alignas(64) std::atomic<size_t> head{0};  // следующий элемент для чтения
+    alignas(64) std::atomic<size_t> tail{0};  // следующая ячейка для записи
+    alignas(64) std::atomic<bool> closed{false};
+    std::atomic<bool> consumerWaiting{false};
+    std::atomic<bool> producerWaiting{false};
+    std::mutex mtx;  // только для сна и пробуждения
+    std::condition_variable cv;
+
+    void wake() {
+        std::lock_guard<std::mutex> lock(mtx);  // под мьютексом, чтобы уведомление не пришло между проверкой и сном
+        cv.notify_one();
+    }
+
+public:
+    explicit SpscQueue(size_t capacity) : buffer(capacity + 1) {}
+
+    bool try_push(const T& value) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        size_t next = (t + 1) % buffer.size();
+        if (next == head.load(std::memory_order_acquire))
+            return false;
+        buffer[t] = value;
+        tail.store(next, std::memory_order_seq_cst);
+        if (consumerWaiting.load(std::memory_order_seq_cst))
+            wake();
+        return true;
+    }
+
+    bool try_pop(T& value) {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire))
+            return false;
+        value = buffer[h];
+        head.store((h + 1) % buffer.size(), std::memory_order_seq_cst);
+        if (producerWaiting.load(std::memory_order_seq_cst))
+            wake();
+        return true;
+    }
+
+    void push(const T& value) {
+        for (int i = 0; i < SPIN_TRIES; ++i)
+            if (try_push(value))
+                return;
+        std::unique_lock<std::mutex> lock(mtx);
+        producerWaiting.store(true, std::memory_order_seq_cst);
+        cv.wait(lock, [&] { return (tail.load() + 1) % buffer.size() != head.load(); });
+        producerWaiting.store(false, std::memory_order_relaxed);
+        lock.unlock();
+        try_push(value);  // место есть, а писатель один
+    }
+
+    // false - очередь закрыта и пуста
+    bool pop(T& value) {
+        for (int i = 0; i < SPIN_TRIES; ++i)
+            if (try_pop(value))
+                return true;
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            consumerWaiting.store(true, std::memory_order_seq_cst);
+            cv.wait(lock, [&] { return head.load() != tail.load() || closed.load(); });
+            consumerWaiting.store(false, std::memory_order_relaxed);
+        }
+        return try_pop(value);  // элемент мог появиться перед закрытием
+    }
+
+    void close() {
+        closed.store(true, std::memory_order_seq_cst);
+        std::lock_guard<std::mutex> lock(mtx);
+        cv.notify_all();
+    }
+};
+
+// восстановление порядка: кадры приходят в любом порядке, отдаются строго по возрастанию index.
+// в полете не больше capacity кадров, поэтому кадр index всегда попадает в ячейку index % capacity
+class ReorderBuffer {
+private:
+    std::vector<Frame*> slots;
+    long nextIndex = 0;  // номер следующего кадра на выдачу
+    size_t held = 0;     // кадров ждут своей очереди
+    size_t maxHeld = 0;
+
+public:
+    explicit ReorderBuffer(size_t capacity) : slots(capacity, nullptr) {}
+
+    // emit вызывается для каждого кадра, который стал непрерывным продолжением уже выданных
+    template<typename Emit>
+    void insert(Frame* frame, Emit&& emit) {
+        slots[frame->index % slots.size()] = frame;
+        ++held;
+        if (held > maxHeld)
+            maxHeld = held;
+        while (slots[nextIndex % slots.size()] != nullptr) {
+            Frame* ready = slots[nextIndex % slots.size()];
+            slots[nextIndex % slots.size()] = nullptr;
+            --held;
+            ++nextIndex;
+            emit(ready);
+        }
+    }
+
+    size_t max_held() const { return maxHeld; }
+};
+
+// статистика стадии: сколько кадров прошло, сколько времени стадия была занята
+// и задержка кадра на стадии - ожидание в очереди перед ней плюс обработка
+struct StageStats {
+    std::atomic<uint64_t> frames{0};
+    std::atomic<uint64_t> busyNs{0};
+    LatencyHistogram latency;  // нс
+
+    // обработка кадра, начатая в start, закончена; возвращает текущее время
+    PipelineClock::time_point add_busy(PipelineClock::time_point start) {
+        auto now = PipelineClock::now();
+        frames.fetch_add(1, std::memory_order_relaxed);
+        busyNs.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(now - start).count(),
+                         std::memory_order_relaxed);
+        return now;
+    }
+
+    // кадр, поступивший на стадию в queued, покидает ее в now
+    void add_latency(PipelineClock::time_point queued, PipelineClock::time_point now) {
+        latency.record(std::chrono::duration_cast<std::chrono::nanoseconds>(now - queued).count());
+    }
+
+    PipelineClock::time_point add(PipelineClock::time_point queued, PipelineClock::time_point start) {
+        auto now = add_busy(start);
+        add_latency(queued, now);
+        return now;
+    }
+};
+
+struct PipelineConfig {
+    int workers = 1;             // потоков обработки
+    size_t poolSize = 64;        // кадров в пуле, ограничивает память и окно переупорядочивания
+    size_t queueCapacity = 16;   // емкость очередей между стадиями
+    size_t frameBytes = 0;       // размер буфера кадра
+};
+
+class FramePipeline {
+public:
+    using ReadFn = std::function<bool(Frame&)>;          // заполнить кадр; false - поток закончился
+    using ProcessFn = std::function<void(Frame&)>;       // обработка кадра на месте
+    using WriteFn = std::function<void(const Frame&)>;   // кадры приходят строго по порядку
+
+    StageStats readStats, processStats, reorderStats, writeStats;
+    LatencyHistogram latency;  // от чтения кадра до окончания его записи, нс
+
+private:
+    PipelineConfig config;
+    ReadFn readFrame;
+    ProcessFn processFrame;
+    WriteFn writeFrame;
+    FramePool pool;
+    BoundedQueue<Frame*> readQueue;
+    BoundedQueue<Frame*> processedQueue;
+    SpscQueue<Frame*> orderedQueue;
+    ReorderBuffer reorder;
+    std::atomic<int> activeWorkers{0};
+
+public:
+    FramePipeline(const PipelineConfig& config, ReadFn read, ProcessFn process, WriteFn write)
+        : config(config), readFrame(std::move(read)), processFrame(std::move(process)),
+          writeFrame(std::move(write)), pool(config.poolSize, config.frameBytes),
+          readQueue(config.queueCapacity), processedQueue(config.queueCapacity),
+          orderedQueue(config.poolSize), reorder(config.poolSize) {}  // кадров не больше poolSize, reorder не ждет запись
+
+    // запуск всех стадий, возврат после записи последнего кадра
+    void run() {
+        activeWorkers = config.workers;
+        std::thread reader(&FramePipeline::read_stage, this);
+        std::vector<std::thread> workers;
+        for (int i = 0; i < config.workers; ++i)
+            workers.emplace_back(&FramePipeline::process_stage, this);
+        std::thread reorderer(&FramePipeline::reorder_stage, this);
+        std::thread writer(&FramePipeline::write_stage, this);
+
+        reader.join();
+        for (auto& thread : workers)
+            thread.join();
+        reorderer.join();
+        writer.join();
+    }
+
+    size_t max_reorder_held() const { return reorder.max_held(); }
+
+private:
+    void read_stage() {
+        long index = 0;
+        while (true) {
+            auto queued = PipelineClock::now();
+            Frame* frame = pool.acquire();  // ждет, если все кадры в работе
+            auto start = PipelineClock::now();
+            frame->index = index;
+            if (!readFrame(*frame)) {
+                pool.release(frame);
+                break;
+            }
+            frame->readTime = readStats.add(queued, start);
+            frame->stageTime = frame->readTime;
+            readQueue.push(frame);
+            ++index;
+        }
+        readQueue.close();
+    }
+
+    void process_stage() {
+        Frame* frame;
+        while (readQueue.pop(frame)) {
+            auto start = PipelineClock::now();
+            processFrame(*frame);
+            frame->stageTime = processStats.add(frame->stageTime, start);
+            processedQueue.push(frame);
+        }
+        if (--activeWorkers == 0)  // последний обработчик закрывает выходную очередь
+            processedQueue.close();
+    }
+
+    void reorder_stage() {
+        Frame* frame;
+        while (processedQueue.pop(frame)) {
+            auto start = PipelineClock::now();
+            // задержка на этой стадии включает ожидание кадров с меньшими номерами;
+            // все кадры, выпущенные одной вставкой, получают одну отметку времени
+            reorder.insert(frame, [&](Frame* ready) {
+                reorderStats.add_latency(ready->stageTime, start);
+                ready->stageTime = start;
+                orderedQueue.push(ready);
+            });
+            reorderStats.add_busy(start);  // вставка и передача кадров дальше
+        }
+        orderedQueue.close();
+    }
+
+    void write_stage() {
+        Frame* frame;
+        while (orderedQueue.pop(frame)) {
+            auto start = PipelineClock::now();
+            writeFrame(*frame);
+            auto end = writeStats.add(frame->stageTime, start);
+            latency.record(std::chrono::duration_cast<std::chrono::nanoseconds>(end - frame->readTime).count());
+            pool.release(frame);
+        }
+    }
+};
@@ -0,0 +1,202 @@
+#pragma once
+
+#include <thread>
+#include <vector>
+#include <string>
+#include <mutex>
+#include <condition_variable>
+#include <fstream>
+#include <iostream>
+#include <charconv>
+#include <cstring>
+#include <cstdint>
+
+#include "server.h"
+
+// формат выходных файлов
+enum class SinkFormat {
+    Text,   // "sin(arg) = result", как раньше
+    Binary  // записи {uint64 id; double arg; double result} без разделителей
+};
+
+// что делать, если очередь на запись заполнена
+enum class SinkOverflow {
+    Block,  // сервер ждет, пока поток записи не освободит место
+    Drop    // результат отбрасывается и учитывается в dropped()
+};
+
+// асинхронная запись результатов: сервер только кладет задачу в очередь,
+// а форматирование и запись на диск делает отдельный поток
+class ResultSink {
+private:
+    static constexpr int NUM_TYPES = 3;  // sin, sqrt, pow
+
+    struct Output {
+        std::ofstream file;
+        std::string buffer;  // накопленные данные, сбрасываются в файл крупными блоками
+    };
+
+    std::vector<Task> pending;   // задачи, ожидающие записи, не больше capacity
+    std::mutex mtx;              // защищает pending, isRunning и dropCount
+    std::condition_variable cv;  // будит поток записи
+    std::condition_variable spaceCv;  // ожидание места в pending
+    bool isRunning = false;      // флаг работы потока записи
+    std::thread writerThread;    // поток записи
+    Output outputs[NUM_TYPES];
+    SinkFormat format;
+    size_t bufferSize;           // порог сброса буфера в файл, байт
+    size_t capacity;             // максимум задач в очереди на запись
+    SinkOverflow overflow;
+    size_t dropCount = 0;        // отброшено результатов при SinkOverflow::Drop
+    bool writeFailed = false;    // ошибка записи в файл, меняет только поток записи
+
+public:
+    explicit ResultSink(SinkFormat format = SinkFormat::Text, size_t capacity = 1 << 16,
+                        SinkOverflow overflow = SinkOverflow::Block, size_t bufferSize = 1 << 20)
+        : format(format), bufferSize(bufferSize), capacity(capacity ? capacity : 1), overflow(overflow) {
+        pending.reserve(this->capacity);  // очередь не растет и не перевыделяется
+    }
+
+    ~ResultSink() {
+        if (writerThread.joinable())
+            stop();
+    }
+
+    // открытие файлов и запуск потока записи; false - файл не удалось открыть, поток не запущен
+    bool start() {
+        static const char* names[NUM_TYPES] = {"sin_results", "sqrt_results", "pow_results"};
+        const bool binary = format == SinkFormat::Binary;
+        for (int i = 0; i < NUM_TYPES; ++i) {
+            std::string name = std::string(names[i]) + (binary ? ".bin" : ".txt");
+            outputs[i].file.open(name, binary ? std::ios::binary : std::ios::out);
+            if (!outputs[i].file.is_open()) {
+                std::cerr << "ResultSink: cannot open " << name << " for writing" << std::endl;
+                for (int j = 0; j < i; ++j)
+                    outputs[j].file.close();
+                return false;
+            }
+            outputs[i].buffer.reserve(bufferSize + 128);
+        }
+        isRunning = true;
+        writerThread = std::thread(&ResultSink::write_results, this);
+        return true;
+    }
+
+    // дописывает оставшиеся результаты и закрывает файлы; false - при записи была ошибка
+    bool stop() {
+        if (!writerThread.joinable())
+            return false;
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            isRunning = false;
+        }
+        cv.notify_one();
+        spaceCv.notify_all();
+        writerThread.join();
+        return !writeFailed;
+    }
+
+    // передача готового результата на запись; при полной очереди - ожидание или отказ по политике
+    void push(const Task& task) {
+        bool wasEmpty;
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            if (pending.size() >= capacity) {
+                if (overflow == SinkOverflow::Drop) {
+                    ++dropCount;
+                    return;
+                }
+                spaceCv.wait(lock, [&] { return pending.size() < capacity || !isRunning; });
+                if (!isRunning) {
+                    ++dropCount;
+                    return;
+                }
+            }
+            wasEmpty = pending.empty();
+            pending.push_back(task);
+        }
+        if (wasEmpty)  // поток записи спит только при пустой очереди
+            cv.notify_one();
+    }
+
+    size_t dropped() {
+        std::lock_guard<std::mutex> lock(mtx);
+        return dropCount;
+    }
+
+private:
+    // основной цикл потока записи: забирает всю очередь целиком и форматирует вне блокировки
+    void write_results() {
+        std::vector<Task> batch;
+        batch.reserve(capacity);
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(mtx);
+                cv.wait(lock, [&] { return !pending.empty() || !isRunning; });
+                if (pending.empty())  // остановка и все записано
+                    break;
+                batch.swap(pending);
+            }
+            spaceCv.notify_all();  // очередь снова пуста
+
+            for (const Task& task : batch) {
+                if (task.operation_type < 1 || task.operation_type > NUM_TYPES)
+                    continue;
+                Output& out = outputs[task.operation_type - 1];
+                if (format == SinkFormat::Binary)
+                    append_binary(out.buffer, task);
+                else
+                    append_text(out.buffer, task);
+                if (out.buffer.size() >= bufferSize)
+                    flush(out);
+            }
+            batch.clear();
+        }
+
+        for (Output& out : outputs) {
+            flush(out);
+            out.file.close();
+            if (out.file.fail())
+                writeFailed = true;
+        }
+    }
+
+    void flush(Output& out) {
+        out.file.write(out.buffer.data(), out.buffer.size());
+        if (!out.file)
+            writeFailed = true;
+        out.buffer.clear();
+    }
+
+    // число в том же виде, что дает std::ostream по умолчанию (%g, 6 знаков)
+    static void append_number(std::string& buf, double value) {
+        char tmp[32];
+        auto res = std::to_chars(tmp, tmp + sizeof(tmp), value, std::chars_format::general, 6);
+        buf.append(tmp, res.ptr);
+    }
+
+    static void append_text(std::string& buf, const Task& task) {
+        if (task.operation_type == 1) {
+            buf += "sin(";
+            append_number(buf, task.arg);
+            buf += ") = ";
+        } else if (task.operation_type == 2) {
+            buf += "sqrt(";
+            append_number(buf, task.arg);
+            buf += ") = ";
+        } else {
+            append_number(buf, task.arg);
+            buf += "^2 = ";
+        }
+        append_number(buf, task.result);
+        buf += '\n';
+    }
+
+    static void append_binary(std::string& buf, const Task& task) {
+        char rec[sizeof(uint64_t) + 2 * sizeof(double)];
+        std::memcpy(rec, &task.id, sizeof(uint64_t));
+        std::memcpy(rec + sizeof(uint64_t), &task.arg, sizeof(double));
+        std::memcpy(rec + sizeof(uint64_t) + sizeof(double), &task.result, sizeof(double));
+        buf.append(rec, sizeof(rec));
+    }
+};
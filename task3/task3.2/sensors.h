@@ -0,0 +1,224 @@
+#pragma once
+
+#include <thread>
+#include <vector>
+#include <string>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// сбор показаний датчиков по мотивам task4: каждый датчик опрашивается своим потоком
+// и публикует последнее значение в ячейку с seqlock вместо растущей очереди,
+// потребитель со своей частотой снимает срез всех датчиков и видит самые свежие значения
+
+using SensorClock = std::chrono::steady_clock;
+
+// показание датчика
+struct SensorReading {
+    int64_t value = 0;
+    int64_t timestampNs = 0;  // момент измерения, нс от начала эпохи SensorClock
+    uint64_t sequence = 0;    // номер измерения, 0 - измерений еще не было
+};
+
+// ячейка "последнее значение" на seqlock: один писатель не ждет никогда,
+// читатель повторяет чтение, если попал на запись. поля хранятся в атомиках,
+// поэтому одновременное чтение и запись не являются гонкой данных
+class LatestValueSlot {
+private:
+    alignas(64) std::atomic<uint64_t> seq{0};  // нечетное - идет запись
+    std::atomic<int64_t> value{0};
+    std::atomic<int64_t> timestampNs{0};
+    std::atomic<uint64_t> sequence{0};
+
+public:
+    void publish(const SensorReading& reading) {
+        uint64_t s = seq.load(std::memory_order_relaxed);
+        seq.store(s + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        value.store(reading.value, std::memory_order_relaxed);
+        timestampNs.store(reading.timestampNs, std::memory_order_relaxed);
+        sequence.store(reading.sequence, std::memory_order_relaxed);
+        seq.store(s + 2, std::memory_order_release);
+    }
+
+    // версия ячейки; читать вместе с try_read для проверки, что между чтениями не было записи
+    uint64_t version() const {
+        return seq.load(std::memory_order_acquire);
+    }
+
+    // одна попытка согласованного чтения; false - попали на запись
+    bool try_read(SensorReading& out, uint64_t& readVersion) const {
+        uint64_t s1 = seq.load(std::memory_order_acquire);
+        if (s1 & 1)
+            return false;
+        out.value = value.load(std::memory_order_relaxed);
+        out.timestampNs = timestampNs.load(std::memory_order_relaxed);
+        out.sequence = sequence.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        readVersion = s1;
+        return seq.load(std::memory_order_relaxed) == s1;
+    }
+};
+
+// счетчики датчика со стороны потребителя
+struct SensorCounters {
+    uint64_t snapshots = 0;   // срезов, в которых датчик уже имел значение
+    uint64_t fresh = 0;       // срезов с новым измерением
+    uint64_t repeated = 0;    // срезов с тем же измерением, что в прошлый раз
+    uint64_t stale = 0;       // срезов, где значение старше staleAfter
+    uint64_t skipped = 0;     // измерений, перезаписанных до того, как их увидел потребитель
+    uint64_t retries = 0;     // повторов чтения из-за одновременной записи
+    int64_t maxAgeNs = 0;     // наибольший возраст значения в срезе
+};
+
+class SensorHub {
+public:
+    using ReadFn = std::function<int64_t()>;  // одно измерение датчика, может блокироваться
+
+private:
+    struct Sensor {
+        std::string name;
+        std::chrono::nanoseconds period;
+        std::chrono::nanoseconds staleAfter;
+        ReadFn read;
+        LatestValueSlot slot;
+        std::thread thread;
+        std::atomic<uint64_t> published{0};
+        SensorCounters counters;   // меняет только потребитель
+        uint64_t lastSeen = 0;     // последний номер измерения, который видел потребитель
+        uint64_t versionSeen = 0;  // версия ячейки при последнем чтении
+    };
+
+    std::vector<std::unique_ptr<Sensor>> sensors;
+    std::mutex mtx;              // только для сна датчиков, чтобы stop() будил их сразу
+    std::condition_variable cv;
+    bool isRunning = false;
+    uint64_t inconsistent = 0;   // повторов среза, меняет только потребитель
+
+    static int64_t now_ns() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            SensorClock::now().time_since_epoch()).count();
+    }
+
+public:
+    ~SensorHub() {
+        stop();
+    }
+
+    // датчик опрашивается раз в period; значение старше staleAfter считается устаревшим
+    // (по умолчанию - два периода). добавлять до start()
+    template<typename Rep, typename Period>
+    size_t add_sensor(std::string name, std::chrono::duration<Rep, Period> period, ReadFn read,
+                      std::chrono::nanoseconds staleAfter = std::chrono::nanoseconds(0)) {
+        auto sensor = std::make_unique<Sensor>();
+        sensor->name = std::move(name);
+        sensor->period = std::chrono::duration_cast<std::chrono::nanoseconds>(period);
+        sensor->staleAfter = staleAfter.count() > 0 ? staleAfter : 2 * sensor->period;
+        sensor->read = std::move(read);
+        sensors.push_back(std::move(sensor));
+        return sensors.size() - 1;
+    }
+
+    size_t size() const { return sensors.size(); }
+    const std::string& name(size_t i) const { return sensors[i]->name; }
+    uint64_t published(size_t i) const { return sensors[i]->published.load(); }
+    const SensorCounters& counters(size_t i) const { return sensors[i]->counters; }
+
+    void start() {
+        isRunning = true;
+        for (auto& sensor : sensors)
+            sensor->thread = std::thread(&SensorHub::poll_sensor, this, sensor.get());
+    }
+
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            if (!isRunning)
+                return;
+            isRunning = false;
+        }
+        cv.notify_all();
+        for (auto& sensor : sensors)
+            sensor->thread.join();
+    }
+
+    // срез всех датчиков. сначала пробуем снять его целиком без записей между чтениями
+    // (версии всех ячеек не изменились), после maxAttempts неудач каждый датчик
+    // все равно прочитан согласованно, но в немного разные моменты. out переиспользуется.
+    // вызывать из одного потока-потребителя
+    void snapshot(std::vector<SensorReading>& out, int maxAttempts = 4) {
+        out.resize(sensors.size());
+        for (int attempt = 0; attempt < maxAttempts; ++attempt) {
+            for (size_t i = 0; i < sensors.size(); ++i)
+                read_slot(*sensors[i], out[i]);
+            bool unchanged = true;
+            for (auto& sensor : sensors)
+                if (sensor->slot.version() != sensor->versionSeen)
+                    unchanged = false;
+            if (unchanged)
+                break;
+            ++inconsistent;
+        }
+        account(out);
+    }
+
+    // сколько раз срез пришлось снимать заново из-за записи во время чтения
+    uint64_t inconsistent_snapshots() const { return inconsistent; }
+
+private:
+    void read_slot(Sensor& sensor, SensorReading& out) {
+        while (!sensor.slot.try_read(out, sensor.versionSeen)) {
+            ++sensor.counters.retries;
+            std::this_thread::yield();
+        }
+    }
+
+    void account(const std::vector<SensorReading>& readings) {
+        int64_t now = now_ns();
+        for (size_t i = 0; i < sensors.size(); ++i) {
+            Sensor& sensor = *sensors[i];
+            const SensorReading& r = readings[i];
+            if (r.sequence == 0)
+                continue;
+            SensorCounters& c = sensor.counters;
+            ++c.snapshots;
+            if (r.sequence == sensor.lastSeen) {
+                ++c.repeated;
+            } else {
+                ++c.fresh;
+                if (sensor.lastSeen != 0 && r.sequence > sensor.lastSeen + 1)
+                    c.skipped += r.sequence - sensor.lastSeen - 1;
+                sensor.lastSeen = r.sequence;
+            }
+            int64_t age = now - r.timestampNs;
+            if (age > c.maxAgeNs)
+                c.maxAgeNs = age;
+            if (age > sensor.staleAfter.count())
+                ++c.stale;
+        }
+    }
+
+    // поток датчика: измерение по расписанию и публикация в ячейку
+    void poll_sensor(Sensor* sensor) {
+        auto next = SensorClock::now();
+        uint64_t sequence = 0;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(mtx);
+                if (cv.wait_until(lock, next, [&] { return !isRunning; }))
+                    break;
+            }
+            SensorReading reading;
+            reading.value = sensor->read();
+            reading.timestampNs = now_ns();
+            reading.sequence = ++sequence;
+            sensor->slot.publish(reading);
+            sensor->published.fetch_add(1, std::memory_order_relaxed);
+            next += sensor->period;
+        }
+    }
+};
@@ -0,0 +1,201 @@
+#pragma once
+
+#include <thread>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <optional>
+#include <stdexcept>
+#include <cmath>
+#include <chrono>
+#include <cstdint>
+
+// структура для описания задачи
+struct Task {
+    uint64_t id = 0;     // номер задачи в порядке постановки, назначает сервер
+    int operation_type;  // 1: sin, 2: sqrt, 3: pow
+    double arg;          // значение для вычисления
+    double result;
+    int client_id = -1;  // номер клиента, сервер его не использует и возвращает как есть
+    std::chrono::steady_clock::time_point submit_time;  // момент постановки в очередь; если не задан клиентом, ставит сервер
+};
+
+// счетчики сервера
+struct ServerStats {
+    size_t submitted = 0;        // принято задач
+    size_t completed = 0;        // выполнено задач
+    size_t rejected = 0;         // отказов try_add_task / add_task_for
+    size_t blocked = 0;          // сколько раз клиент ждал места в очереди
+    size_t queueHighWater = 0;   // максимальная длина очереди
+};
+
+// шаблонный класс сервера.
+// очередь задач и хранилище результатов - кольцевые буферы, выделенные в конструкторе,
+// поэтому в установившемся режиме сервер не обращается к куче
+template<typename T>
+class Server {
+private:
+    std::vector<Task> taskQueue;  // очередь задач фиксированной емкости
+    size_t queueHead = 0;         // индекс первой задачи в очереди
+    size_t queueSize = 0;         // число задач в очереди
+    struct ResultSlot {
+        Task task;
+        bool filled = false;      // в ячейке уже есть результат
+    };
+    std::vector<ResultSlot> results;  // последние results.size() результатов, задача id лежит в ячейке id % size
+    uint64_t nextId = 0;          // id следующей принятой задачи
+    ServerStats counters;
+    std::mutex mtx;              // мьютекс для обеспечения безопасности доступа к данным
+    std::condition_variable cv;  // условная переменная для синхронизации потоков
+    std::condition_variable spaceCv;   // ожидание места в очереди клиентами
+    std::condition_variable resultCv;  // отдельная переменная для ожидающих результат, чтобы не забирать уведомления у рабочих потоков
+    bool isRunning = true;       // флаг работы сервера
+    std::vector<std::thread> serverThreads;  // потоки для выполнения задач
+    std::function<void(const Task&)> onResult;  // обработчик готового результата (например, ResultSink)
+
+public:
+    // queueCapacity - максимум задач в очереди, resultCapacity - сколько последних результатов доступно через request_result
+    explicit Server(size_t queueCapacity = 1024, size_t resultCapacity = 4096)
+        : taskQueue(queueCapacity), results(resultCapacity) {
+        if (queueCapacity == 0 || resultCapacity == 0)
+            throw std::invalid_argument("Server: capacity must be positive");
+    }
+
+    // запуск сервера; при нескольких рабочих потоках результаты идут в порядке завершения, а не постановки
+    void start(int num_workers = 1) {
+        for (int i = 0; i < num_workers; ++i)
+            serverThreads.emplace_back(&Server::process_tasks, this);
+    }
+
+    // остановка сервера: оставшиеся в очереди задачи дорабатываются, новые не принимаются
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            isRunning = false;
+        }
+        cv.notify_all();      // уведомление всех потоков о завершении работы
+        spaceCv.notify_all();
+        for (auto& thread : serverThreads)
+            thread.join();  // ожидание завершения потоков
+        serverThreads.clear();
+    }
+
+    // обработчик вызывается из рабочего потока сервера для каждой выполненной задачи,
+    // задается до start()
+    void set_result_handler(std::function<void(const Task&)> handler) {
+        onResult = std::move(handler);
+    }
+
+    // добавление задачи в очередь и возврат ее id; при полной очереди клиент ждет
+    uint64_t add_task(Task task) {
+        std::unique_lock<std::mutex> lock(mtx);
+        if (is_full())
+            ++counters.blocked;
+        spaceCv.wait(lock, [&] { return !is_full() || !isRunning; });
+        if (!isRunning)
+            throw std::runtime_error("Server: add_task after stop");
+        return push(task);
+    }
+
+    // добавление без ожидания: при полной очереди задача отклоняется
+    std::optional<uint64_t> try_add_task(Task task) {
+        std::unique_lock<std::mutex> lock(mtx);
+        if (is_full() || !isRunning) {
+            ++counters.rejected;
+            return std::nullopt;
+        }
+        return push(task);
+    }
+
+    // добавление с ожиданием места не дольше timeout
+    template<typename Rep, typename Period>
+    std::optional<uint64_t> add_task_for(Task task, std::chrono::duration<Rep, Period> timeout) {
+        std::unique_lock<std::mutex> lock(mtx);
+        if (is_full())
+            ++counters.blocked;
+        if (!spaceCv.wait_for(lock, timeout, [&] { return !is_full() || !isRunning; }) || !isRunning) {
+            ++counters.rejected;
+            return std::nullopt;
+        }
+        return push(task);
+    }
+
+    // запрос результата выполнения задачи по ее id;
+    // хранятся только последние resultCapacity результатов, для вытесненных бросается std::out_of_range
+    Task request_result(uint64_t id_res) {
+        std::unique_lock<std::mutex> lock(mtx);
+        if (id_res >= nextId)
+            throw std::out_of_range("Server: unknown task id");
+        const ResultSlot& slot = results[id_res % results.size()];
+        // ожидание, пока результат не станет доступным
+        resultCv.wait(lock, [&] { return slot.filled && slot.task.id >= id_res; });
+        if (slot.task.id != id_res)
+            throw std::out_of_range("Server: result evicted");
+        return slot.task;
+    }
+
+    ServerStats stats() {
+        std::lock_guard<std::mutex> lock(mtx);
+        return counters;
+    }
+
+private:
+    bool is_full() const {
+        return queueSize == taskQueue.size();
+    }
+
+    // вызывается под мьютексом, место в очереди есть
+    uint64_t push(Task& task) {
+        task.id = nextId++;
+        if (task.submit_time.time_since_epoch().count() == 0)
+            task.submit_time = std::chrono::steady_clock::now();
+        taskQueue[(queueHead + queueSize) % taskQueue.size()] = task;
+        ++queueSize;
+        ++counters.submitted;
+        if (queueSize > counters.queueHighWater)
+            counters.queueHighWater = queueSize;
+        cv.notify_one();  // уведомление одного потока о наличии задачи
+        return task.id;
+    }
+
+    // метод выполнения задач
+    void process_tasks() {
+        while (true) {
+            Task task;
+            {
+                std::unique_lock<std::mutex> lock(mtx);
+                cv.wait(lock, [&] { return queueSize != 0 || !isRunning; });
+                if (queueSize == 0)  // сервер остановлен и очередь пуста
+                    break;
+                task = taskQueue[queueHead];
+                queueHead = (queueHead + 1) % taskQueue.size();
+                --queueSize;
+            }
+            spaceCv.notify_one();  // освободилось место для ожидающего клиента
+
+            // выполнение операций в зависимости от типа задачи
+            if (task.operation_type == 1) {
+                task.result = static_cast<T>(std::sin(task.arg));
+            } else if (task.operation_type == 2) {
+                task.result = static_cast<T>(std::sqrt(task.arg));
+            } else if (task.operation_type == 3) {
+                task.result = static_cast<T>(std::pow(task.arg, 2));
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                ResultSlot& slot = results[task.id % results.size()];
+                if (!slot.filled || slot.task.id < task.id) {  // при нескольких потоках более новый результат мог занять ячейку раньше
+                    slot.task = task;
+                    slot.filled = true;
+                }
+                ++counters.completed;
+            }
+            resultCv.notify_all();  // уведомление ожидающих request_result
+
+            if (onResult)
+                onResult(task);  // результат уходит дальше сразу, не дожидаясь остальных
+        }
+    }
+};
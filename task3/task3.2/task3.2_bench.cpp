@@ -0,0 +1,222 @@
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include <vector>
+#include <string>
+#include <random>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
+#include <cstring>
+#include <memory>
+
+#include "server.h"
+#include "histogram.h"
+
+// нагрузочный тест сервера: задержка от постановки задачи до ее выполнения и пропускная способность
+//   open   - открытая модель, задачи приходят с фиксированной частотой независимо от сервера;
+//            задержка считается от запланированного момента прихода, так что отставание клиента тоже учитывается
+//   closed - замкнутая модель, у каждого клиента в полете не больше window задач
+
+using Clock = std::chrono::steady_clock;
+
+struct BenchConfig {
+    std::string mode = "closed";        // open | closed
+    int clients = 3;                    // потоки-клиенты
+    int workers = 1;                    // рабочие потоки сервера
+    long tasks = 100000;                // задач на одного клиента
+    double rate = 100000;               // суммарная частота прихода задач в open, задач/с
+    int window = 1;                     // задач в полете на клиента в closed
+    std::vector<double> mix = {1, 1, 1};  // доли sin, sqrt, pow
+    long queue = 1024;                  // емкость очереди сервера; знаковая, чтобы отрицательное значение не стало огромным size_t
+    std::string admit = "block";        // block | try | timeout - что делать при полной очереди
+    long timeoutUs = 100;               // ожидание места в очереди для timeout, мкс
+};
+
+// ограничение числа задач в полете одного клиента для замкнутой модели
+class InFlightLimiter {
+private:
+    std::mutex mtx;
+    std::condition_variable cv;
+    long inFlight = 0;
+    long limit;
+
+public:
+    explicit InFlightLimiter(long limit) : limit(limit) {}
+
+    void acquire() {
+        std::unique_lock<std::mutex> lock(mtx);
+        cv.wait(lock, [&] { return inFlight < limit; });
+        ++inFlight;
+    }
+
+    void release() {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            --inFlight;
+        }
+        cv.notify_one();
+    }
+};
+
+void print_usage(const char* name) {
+    std::cout << "usage: " << name << " [--mode open|closed] [--clients N] [--workers N] [--tasks N]"
+              << " [--rate TASKS_PER_SEC] [--window N] [--mix SIN,SQRT,POW]"
+              << " [--queue N] [--admit block|try|timeout] [--timeout-us N]\n";
+}
+
+bool parse_args(int argc, char** argv, BenchConfig& cfg) {
+    for (int i = 1; i < argc; ++i) {
+        std::string key = argv[i];
+        if (key == "--help" || key == "-h" || i + 1 >= argc)
+            return false;
+        const char* value = argv[++i];
+        if (key == "--mode")
+            cfg.mode = value;
+        else if (key == "--clients")
+            cfg.clients = atoi(value);
+        else if (key == "--workers")
+            cfg.workers = atoi(value);
+        else if (key == "--tasks")
+            cfg.tasks = atol(value);
+        else if (key == "--rate")
+            cfg.rate = atof(value);
+        else if (key == "--window")
+            cfg.window = atoi(value);
+        else if (key == "--queue")
+            cfg.queue = atol(value);
+        else if (key == "--admit")
+            cfg.admit = value;
+        else if (key == "--timeout-us")
+            cfg.timeoutUs = atol(value);
+        else if (key == "--mix") {
+            cfg.mix.clear();
+            for (const char* p = value; *p; ) {
+                cfg.mix.push_back(atof(p));
+                p = std::strchr(p, ',');
+                if (!p)
+                    break;
+                ++p;
+            }
+            if (cfg.mix.size() != 3)
+                return false;
+        } else
+            return false;
+    }
+    return (cfg.mode == "open" || cfg.mode == "closed") && cfg.clients > 0 && cfg.workers > 0
+        && cfg.tasks > 0 && cfg.rate > 0 && cfg.window > 0 && cfg.queue > 0
+        && (cfg.admit == "block" || cfg.admit == "try" || cfg.admit == "timeout");
+}
+
+// постановка задачи с выбранной политикой; false - задача отклонена
+bool submit(Server<double>& server, const BenchConfig& cfg, const Task& task) {
+    if (cfg.admit == "try")
+        return server.try_add_task(task).has_value();
+    if (cfg.admit == "timeout")
+        return server.add_task_for(task, std::chrono::microseconds(cfg.timeoutUs)).has_value();
+    server.add_task(task);
+    return true;
+}
+
+// клиент открытой модели: i-я задача приходит в start + i * interval
+void open_client(Server<double>& server, const BenchConfig& cfg, Clock::time_point start, int seed) {
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<double> dist(1, 100);
+    std::discrete_distribution<int> op(cfg.mix.begin(), cfg.mix.end());
+    auto interval = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(cfg.clients / cfg.rate));
+    // клиенты сдвинуты друг относительно друга, чтобы суммарный поток был равномерным
+    auto next = start + interval * seed / cfg.clients;
+
+    for (long i = 0; i < cfg.tasks; ++i) {
+        std::this_thread::sleep_until(next);
+        Task task;
+        task.operation_type = op(gen) + 1;
+        task.arg = dist(gen);
+        task.submit_time = next;
+        submit(server, cfg, task);  // отклоненная задача просто теряется
+        next += interval;
+    }
+}
+
+// клиент замкнутой модели: новая задача только после освобождения места в окне
+void closed_client(Server<double>& server, const BenchConfig& cfg, InFlightLimiter& limiter, int seed) {
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<double> dist(1, 100);
+    std::discrete_distribution<int> op(cfg.mix.begin(), cfg.mix.end());
+
+    for (long i = 0; i < cfg.tasks; ++i) {
+        limiter.acquire();
+        Task task;
+        task.operation_type = op(gen) + 1;
+        task.arg = dist(gen);
+        task.client_id = seed;
+        if (!submit(server, cfg, task))
+            limiter.release();
+    }
+}
+
+int main(int argc, char** argv) {
+    BenchConfig cfg;
+    if (!parse_args(argc, argv, cfg)) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    LatencyHistogram histogram;
+    std::vector<std::unique_ptr<InFlightLimiter>> limiters;  // свой лимит у каждого клиента
+    for (int i = 0; i < cfg.clients; ++i)
+        limiters.push_back(std::make_unique<InFlightLimiter>(cfg.window));
+    std::atomic<int64_t> lastDone{0};  // время последнего выполнения, нс от начала эпохи steady_clock
+    const bool closed = cfg.mode == "closed";
+
+    Server<double> server(static_cast<size_t>(cfg.queue));
+    server.set_result_handler([&](const Task& task) {
+        auto now = Clock::now();
+        histogram.record(std::chrono::duration_cast<std::chrono::nanoseconds>(now - task.submit_time).count());
+        int64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(now.time_since_epoch()).count();
+        int64_t prev = lastDone.load(std::memory_order_relaxed);
+        while (prev < ns && !lastDone.compare_exchange_weak(prev, ns, std::memory_order_relaxed)) {}
+        if (closed)
+            limiters[task.client_id]->release();
+    });
+    server.start(cfg.workers);
+
+    auto start = Clock::now();
+    std::vector<std::thread> clients;
+    for (int i = 0; i < cfg.clients; ++i) {
+        if (closed)
+            clients.emplace_back(closed_client, std::ref(server), std::cref(cfg), std::ref(*limiters[i]), i);
+        else
+            clients.emplace_back(open_client, std::ref(server), std::cref(cfg), start, i);
+    }
+
+    for (auto& thread : clients)
+        thread.join();
+    server.stop();  // дожидаемся выполнения всех задач
+
+    double runtime = std::chrono::duration<double>(
+        Clock::time_point(std::chrono::nanoseconds(lastDone.load())) - start).count();
+    uint64_t done = histogram.count();
+    ServerStats stats = server.stats();
+
+    std::cout << "mode " << cfg.mode << ", clients " << cfg.clients << ", workers " << cfg.workers
+              << ", tasks " << done;
+    if (closed)
+        std::cout << ", window " << cfg.window;
+    else
+        std::cout << ", target rate " << cfg.rate << " tasks/s";
+    std::cout << ", queue " << cfg.queue << ", admit " << cfg.admit << "\n";
+    std::cout << "Rejected: " << stats.rejected << ", blocked: " << stats.blocked
+              << ", queue high-water: " << stats.queueHighWater << "\n";
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "Runtime: " << runtime << " seconds\n";
+    std::cout << "Throughput: " << done / runtime << " tasks/s\n";
+    std::cout << "Latency, us: mean " << histogram.mean() / 1e3
+              << ", p50 " << histogram.percentile(50) / 1e3
+              << ", p99 " << histogram.percentile(99) / 1e3
+              << ", p999 " << histogram.percentile(99.9) / 1e3
+              << ", max " << histogram.max() / 1e3 << std::endl;
+    return 0;
+}
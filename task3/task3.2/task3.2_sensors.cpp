@@ -0,0 +1,85 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <thread>
+#include <chrono>
+
+#include "sensors.h"
+#include "histogram.h"
+
+// датчики как в task4: SensorX с задержками 0.01, 0.1 и 1 с, потребитель снимает срез с частотой --freq.
+// измерение датчика - счетчик, который растет на 1 за опрос, поэтому значения в срезах не должны убывать
+
+struct SensorsArgs {
+    double freq = 60;      // срезов в секунду
+    double seconds = 3;    // длительность прогона
+};
+
+bool parse_args(int argc, char** argv, SensorsArgs& args) {
+    for (int i = 1; i < argc; ++i) {
+        std::string key = argv[i];
+        if (i + 1 >= argc)
+            return false;
+        const char* value = argv[++i];
+        if (key == "--freq")
+            args.freq = atof(value);
+        else if (key == "--seconds")
+            args.seconds = atof(value);
+        else
+            return false;
+    }
+    return args.freq > 0 && args.seconds > 0;
+}
+
+int main(int argc, char** argv) {
+    SensorsArgs args;
+    if (!parse_args(argc, argv, args)) {
+        std::cout << "usage: " << argv[0] << " [--freq SNAPSHOTS_PER_SEC] [--seconds N]\n";
+        return 1;
+    }
+
+    SensorHub hub;
+    const double delays[] = {0.01, 0.1, 1};
+    for (double delay : delays) {
+        auto counter = std::make_shared<int64_t>(0);
+        hub.add_sensor("SensorX(" + std::to_string(delay).substr(0, 4) + ")",
+                       std::chrono::duration<double>(delay), [counter] { return ++*counter; });
+    }
+    hub.start();
+
+    std::vector<SensorReading> readings;
+    std::vector<int64_t> last(hub.size(), 0);
+    LatencyHistogram snapshotTime;  // время снятия среза, нс
+    bool monotonic = true;
+
+    auto period = std::chrono::duration_cast<SensorClock::duration>(std::chrono::duration<double>(1 / args.freq));
+    auto start = SensorClock::now();
+    auto end = start + std::chrono::duration_cast<SensorClock::duration>(std::chrono::duration<double>(args.seconds));
+    for (auto next = start; next < end; next += period) {
+        std::this_thread::sleep_until(next);
+        auto t = SensorClock::now();
+        hub.snapshot(readings);
+        snapshotTime.record(std::chrono::duration_cast<std::chrono::nanoseconds>(SensorClock::now() - t).count());
+        for (size_t i = 0; i < readings.size(); ++i) {
+            if (readings[i].value < last[i])
+                monotonic = false;
+            last[i] = readings[i].value;
+        }
+    }
+    hub.stop();
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "Snapshots: " << snapshotTime.count() << " at " << args.freq << " Hz, retaken "
+              << hub.inconsistent_snapshots() << ", snapshot time us: p50 " << snapshotTime.percentile(50) / 1e3
+              << ", p99 " << snapshotTime.percentile(99) / 1e3 << "\n";
+    for (size_t i = 0; i < hub.size(); ++i) {
+        const SensorCounters& c = hub.counters(i);
+        std::cout << std::setw(14) << hub.name(i) << ": published " << hub.published(i)
+                  << ", fresh " << c.fresh << ", repeated " << c.repeated << ", skipped " << c.skipped
+                  << ", stale " << c.stale << ", retries " << c.retries
+                  << ", max age " << c.maxAgeNs / 1e6 << " ms\n";
+    }
+    std::cout << (monotonic ? "OK: sensor values never went backwards" : "FAIL: sensor value went backwards") << std::endl;
+    return monotonic ? 0 : 1;
+}